@@ -0,0 +1,266 @@
+#include "DiffHarness.h"
+#include "EnvBatch.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace chip8
+{
+namespace fuzz
+{
+namespace
+{
+constexpr uint32_t HASH_CHECK_INTERVAL = 64; // Recomputing the hash is much slower than a cycle
+
+// Batched stepping of the embedding API (EnvBatch), one frame being one cycle
+class EnvBatchEngine : public Engine
+{
+public:
+    char const *name() const override { return "EnvBatch"; }
+
+    void load(uint8_t const *rom, std::size_t size, unsigned seed) override
+    {
+        m_batch.reset(new EnvBatch(1, 1, seed));
+        m_batch->loadRom(rom, size);
+        m_keys = 0;
+    }
+
+    void setKeys(uint16_t keys) override { m_keys = keys; }
+    void step() override { m_batch->step(&m_keys, 1); }
+    void saveState(Chip8::State &state) const override { m_batch->machine(0).saveState(state); }
+
+private:
+    std::unique_ptr<EnvBatch> m_batch;
+    uint16_t m_keys = 0;
+};
+
+template<typename T>
+bool compareArray(char const *name, T const *expected, T const *actual, int size, Divergence &divergence)
+{
+    for (int i = 0; i < size; i++)
+        if (expected[i] != actual[i])
+        {
+            std::ostringstream out;
+            out << std::hex << name << "[0x" << i << "]: expected 0x" << +expected[i] << ", got 0x" << +actual[i];
+            divergence.field = name;
+            divergence.description = out.str();
+            return false;
+        }
+
+    return true;
+}
+
+template<typename T>
+bool compareValue(char const *name, T expected, T actual, Divergence &divergence)
+{
+    return compareArray(name, &expected, &actual, 1, divergence);
+}
+
+// Fills the field and description of the first difference, returns false if there is one
+bool compare(Chip8::State const &expected, Chip8::State const &actual, Divergence &divergence)
+{
+    return compareValue("PC", expected.pc, actual.pc, divergence) &&
+            compareValue("I", expected.I, actual.I, divergence) &&
+            compareValue("SP", expected.sp, actual.sp, divergence) &&
+            compareArray("V", expected.registers, actual.registers, 16, divergence) &&
+            compareValue("delay timer", expected.delayTimer, actual.delayTimer, divergence) &&
+            compareValue("sound timer", expected.soundTimer, actual.soundTimer, divergence) &&
+            compareValue("random state", expected.randomState, actual.randomState, divergence) &&
+            compareArray("stack", expected.stack, actual.stack, STACK_SIZE, divergence) &&
+            compareArray("memory", expected.memory, actual.memory, MEMORY_SIZE, divergence) &&
+            compareArray("display", expected.display, actual.display, DISPLAY_SIZE, divergence);
+}
+
+// A candidate of the minimization must fail like the original case
+bool sameDivergence(Divergence const &original, Divergence const &candidate)
+{
+    return candidate.engine == original.engine && candidate.field == original.field;
+}
+} // namespace
+
+std::vector<std::unique_ptr<Engine>> alternateEngines()
+{
+    std::vector<std::unique_ptr<Engine>> engines;
+    engines.emplace_back(new EnvBatchEngine);
+    return engines;
+}
+
+FuzzCase FuzzCase::decode(uint8_t const *data, std::size_t size)
+{
+    FuzzCase fuzzCase;
+    std::size_t offset = 0;
+
+    if (size >= 4)
+    {
+        fuzzCase.seed = data[0] | data[1] << 8 | data[2] << 16 | static_cast<unsigned>(data[3]) << 24;
+        offset = 4;
+    }
+
+    int inputs = offset < size ? data[offset++] : 0;
+    uint32_t cycle = 0;
+    for (int i = 0; i < inputs && offset + 4 <= size; i++, offset += 4)
+    {
+        cycle += data[offset] | data[offset + 1] << 8;
+        fuzzCase.inputs.push_back({cycle, static_cast<uint16_t>(data[offset + 2] | data[offset + 3] << 8)});
+    }
+
+    std::size_t romSize = std::min<std::size_t>(size - std::min(offset, size), MEMORY_SIZE - START_ADDRESS);
+    fuzzCase.rom.assign(data + offset, data + offset + romSize);
+    return fuzzCase;
+}
+
+std::vector<uint8_t> FuzzCase::encode() const
+{
+    // Inputs from CYCLES_PER_CASE on never take effect and are left out, so
+    // the gaps between the others always fit in 16 bits
+    static_assert(CYCLES_PER_CASE <= 0x10000, "cycles between inputs are encoded on 16 bits");
+
+    std::vector<InputEvent> kept;
+    for (InputEvent const &input: inputs)
+        if (input.cycle < CYCLES_PER_CASE && kept.size() < 255)
+            kept.push_back(input);
+
+    std::vector<uint8_t> data = {
+            static_cast<uint8_t>(seed), static_cast<uint8_t>(seed >> 8),
+            static_cast<uint8_t>(seed >> 16), static_cast<uint8_t>(seed >> 24),
+            static_cast<uint8_t>(kept.size())};
+
+    uint32_t cycle = 0;
+    for (InputEvent const &input: kept)
+    {
+        uint32_t gap = input.cycle - cycle;
+        data.push_back(gap);
+        data.push_back(gap >> 8);
+        data.push_back(input.keys);
+        data.push_back(input.keys >> 8);
+        cycle = input.cycle;
+    }
+
+    data.insert(data.end(), rom.begin(), rom.end());
+    return data;
+}
+
+Divergence runCase(FuzzCase const &fuzzCase)
+{
+    Divergence divergence;
+
+    std::unique_ptr<Chip8> reference(new Chip8(fuzzCase.seed));
+    reference->loadGame(fuzzCase.rom.data(), fuzzCase.rom.size());
+
+    std::vector<std::unique_ptr<Engine>> engines = alternateEngines();
+    for (auto &engine: engines)
+        engine->load(fuzzCase.rom.data(), fuzzCase.rom.size(), fuzzCase.seed);
+
+    std::unique_ptr<Chip8::State> expected(new Chip8::State);
+    std::unique_ptr<Chip8::State> actual(new Chip8::State);
+    std::size_t nextInput = 0;
+
+    for (uint32_t cycle = 0; cycle < CYCLES_PER_CASE; cycle++)
+    {
+        while (nextInput < fuzzCase.inputs.size() && fuzzCase.inputs[nextInput].cycle == cycle)
+        {
+            uint16_t keys = fuzzCase.inputs[nextInput++].keys;
+            for (int key = 0; key < 16; key++)
+                reference->m_keypad[key] = (keys >> key) & 0x1;
+            for (auto &engine: engines)
+                engine->setKeys(keys);
+        }
+
+        reference->cycle();
+        reference->saveState(*expected);
+
+        for (auto &engine: engines)
+        {
+            engine->step();
+            engine->saveState(*actual);
+
+            if (!compare(*expected, *actual, divergence))
+            {
+                divergence.engine = engine->name();
+                divergence.cycle = cycle;
+                return divergence;
+            }
+        }
+
+        // The incremental state hash is an optimization too, check it
+        // against a full recomputation
+        if (cycle % HASH_CHECK_INTERVAL == HASH_CHECK_INTERVAL - 1 && reference->stateHash() != reference->computeStateHash())
+        {
+            divergence.engine = "state hash";
+            divergence.field = "hash";
+            divergence.cycle = cycle;
+            divergence.description = "incremental hash differs from the recomputed one";
+            return divergence;
+        }
+    }
+
+    return divergence;
+}
+
+FuzzCase minimize(FuzzCase fuzzCase)
+{
+    Divergence original = runCase(fuzzCase);
+    auto stillDiverges = [&original](FuzzCase const &candidate) { return sameDivergence(original, runCase(candidate)); };
+
+    // Drop the inputs that are not needed
+    for (std::size_t i = fuzzCase.inputs.size(); i-- > 0;)
+    {
+        FuzzCase candidate = fuzzCase;
+        candidate.inputs.erase(candidate.inputs.begin() + i);
+        if (stillDiverges(candidate))
+            fuzzCase = candidate;
+    }
+
+    // Delete chunks of the ROM, halving the chunk size down to one byte
+    for (std::size_t chunk = fuzzCase.rom.size() / 2; chunk > 0; chunk /= 2)
+    {
+        std::size_t position = 0;
+        while (position + chunk <= fuzzCase.rom.size())
+        {
+            FuzzCase candidate = fuzzCase;
+            candidate.rom.erase(candidate.rom.begin() + position, candidate.rom.begin() + position + chunk);
+            if (stillDiverges(candidate))
+                fuzzCase = candidate;
+            else
+                position += chunk;
+        }
+    }
+
+    // Zero the bytes that don't matter, leaving only the relevant ones set
+    for (std::size_t i = 0; i < fuzzCase.rom.size(); i++)
+    {
+        if (fuzzCase.rom[i] == 0)
+            continue;
+
+        FuzzCase candidate = fuzzCase;
+        candidate.rom[i] = 0;
+        if (stillDiverges(candidate))
+            fuzzCase = candidate;
+    }
+
+    return fuzzCase;
+}
+
+std::string describe(FuzzCase const &fuzzCase, Divergence const &divergence)
+{
+    std::ostringstream out;
+
+    out << "Engine " << divergence.engine << " diverged at cycle " << std::dec << divergence.cycle << ": " << divergence.description << "\n";
+    out << "Seed: " << fuzzCase.seed << "\n";
+
+    for (InputEvent const &input: fuzzCase.inputs)
+        out << "Keys at cycle " << std::dec << input.cycle << ": 0x" << std::hex << input.keys << "\n";
+
+    out << "ROM (" << std::dec << fuzzCase.rom.size() << " bytes):";
+    for (std::size_t i = 0; i < fuzzCase.rom.size(); i++)
+    {
+        if (i % 16 == 0)
+            out << "\n   ";
+        out << " " << std::hex << (fuzzCase.rom[i] >> 4) << (fuzzCase.rom[i] & 0xF);
+    }
+    out << "\n";
+
+    return out.str();
+}
+} // namespace fuzz
+} // namespace chip8
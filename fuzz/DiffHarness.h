@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Chip8.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+namespace fuzz
+{
+// An execution engine, run in lockstep with the reference interpreter
+class Engine
+{
+public:
+    virtual ~Engine() = default;
+
+    virtual char const *name() const = 0;
+    virtual void load(uint8_t const *rom, std::size_t size, unsigned seed) = 0;
+    virtual void setKeys(uint16_t keys) = 0; // Bit k = key k pressed
+    virtual void step() = 0; // Runs one cycle
+    virtual void saveState(Chip8::State &state) const = 0;
+};
+
+/* Every alternate engine to check against Chip8::cycle(). New engines go here.
+ * There is no independent interpreter yet: the only engine is the batched
+ * stepping of EnvBatch, which runs Chip8::cycle() itself and can only catch
+ * bugs in its keypad and frame handling. "No divergence" is therefore not
+ * evidence that any other execution engine is bit-exact
+ */
+std::vector<std::unique_ptr<Engine>> alternateEngines();
+
+struct InputEvent
+{
+    uint32_t cycle; // Cycle at which the keypad changes
+    uint16_t keys;
+};
+
+struct FuzzCase
+{
+    unsigned seed = 0; // Seed of the random number generator (CXNN)
+    std::vector<InputEvent> inputs; // Sorted by cycle
+    std::vector<uint8_t> rom;
+
+    /* Encoded as: uint32_t seed, uint8_t number of inputs, then for every
+     * input uint16_t cycles since the previous one and uint16_t keys, then
+     * the ROM, all little endian. Any byte string decodes to a valid case,
+     * and decode(encode()) gives back the same case, minus the inputs that
+     * come too late to have any effect
+     */
+    static FuzzCase decode(uint8_t const *data, std::size_t size);
+    std::vector<uint8_t> encode() const;
+};
+
+struct Divergence
+{
+    std::string engine; // Empty if every engine agrees
+    std::string field; // Part of the state that differs ("PC", "memory", ...)
+    uint32_t cycle = 0;
+    std::string description;
+
+    explicit operator bool() const { return !engine.empty(); }
+};
+
+constexpr uint32_t CYCLES_PER_CASE = 4096;
+
+// Runs the case on the reference interpreter and every alternate engine,
+// comparing their whole state after each cycle
+Divergence runCase(FuzzCase const &fuzzCase);
+
+// Shrinks the ROM and the inputs of a diverging case while it still diverges
+// the same way: same engine and same part of the state
+FuzzCase minimize(FuzzCase fuzzCase);
+
+std::string describe(FuzzCase const &fuzzCase, Divergence const &divergence);
+} // namespace fuzz
+} // namespace chip8
@@ -0,0 +1,99 @@
+#include "DiffHarness.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+
+using namespace chip8::fuzz;
+
+namespace
+{
+FuzzCase randomCase(std::mt19937 &generator)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    FuzzCase fuzzCase;
+
+    fuzzCase.seed = generator();
+
+    int inputs = std::uniform_int_distribution<int>(0, 8)(generator);
+    uint32_t cycle = 0;
+    for (int i = 0; i < inputs; i++)
+    {
+        cycle += byte(generator);
+        fuzzCase.inputs.push_back({cycle, static_cast<uint16_t>(generator())});
+    }
+
+    fuzzCase.rom.resize(std::uniform_int_distribution<int>(2, 512)(generator));
+    for (uint8_t &value: fuzzCase.rom)
+        value = byte(generator);
+
+    return fuzzCase;
+}
+
+int report(FuzzCase const &fuzzCase, std::string const &filename)
+{
+    FuzzCase minimized = minimize(fuzzCase);
+    Divergence divergence = runCase(minimized);
+    std::cerr << describe(minimized, divergence);
+
+    std::vector<uint8_t> data = minimized.encode();
+    std::ofstream(filename, std::ios::binary).write(reinterpret_cast<char const *>(data.data()), data.size());
+    std::cerr << "Minimized case written to " << filename << std::endl;
+
+    // The saved case is only useful if --replay reproduces it
+    Divergence replayed = runCase(FuzzCase::decode(data.data(), data.size()));
+    if (replayed.engine != divergence.engine || replayed.field != divergence.field || replayed.cycle != divergence.cycle)
+        std::cerr << "Warning: the saved case does not replay the same divergence" << std::endl;
+
+    return EXIT_FAILURE;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 3 || (argc == 2 && std::string(argv[1]) == "--help"))
+    {
+        std::cerr << "Usage: " << argv[0] << " [Runs] [Seed]\n";
+        std::cerr << "       " << argv[0] << " --replay <Case>\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (argc == 3 && std::string(argv[1]) == "--replay")
+    {
+        std::ifstream file(argv[2], std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open file: " << argv[2] << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        FuzzCase fuzzCase = FuzzCase::decode(data.data(), data.size());
+        Divergence divergence = runCase(fuzzCase);
+        if (divergence)
+        {
+            std::cerr << describe(fuzzCase, divergence);
+            return EXIT_FAILURE;
+        }
+
+        std::cerr << "No divergence" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    long runs = argc >= 2 ? std::stol(argv[1]) : 1000;
+    unsigned seed = argc == 3 ? std::stoul(argv[2]) : std::random_device()();
+    std::mt19937 generator(seed);
+
+    std::cerr << "Running " << runs << " cases with seed " << seed << std::endl;
+    for (long run = 0; run < runs; run++)
+    {
+        FuzzCase fuzzCase = randomCase(generator);
+        if (runCase(fuzzCase))
+            return report(fuzzCase, "divergence-" + std::to_string(seed) + "-" + std::to_string(run) + ".bin");
+    }
+
+    std::cerr << "No divergence in " << runs << " cases" << std::endl;
+    return EXIT_SUCCESS;
+}
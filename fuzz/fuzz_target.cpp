@@ -0,0 +1,19 @@
+#include "DiffHarness.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace chip8::fuzz;
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const *data, std::size_t size)
+{
+    FuzzCase fuzzCase = FuzzCase::decode(data, size);
+    if (!runCase(fuzzCase))
+        return 0;
+
+    // Report the smallest case that still diverges, then crash so that
+    // libFuzzer saves the input
+    FuzzCase minimized = minimize(fuzzCase);
+    std::cerr << describe(minimized, runCase(minimized));
+    std::abort();
+}
@@ -1,21 +1,186 @@
 #include "Chip8.h"
 
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <random>
 
 namespace chip8
 {
+namespace
+{
+// Each hashed part of the state has its own slot(s); a Zobrist key is derived
+// from the slot and the value it currently holds
+enum HashSlot : uint32_t
+{
+    MEMORY_SLOT = 0, // MEMORY_SIZE slots
+    REGISTERS_SLOT = MEMORY_SLOT + MEMORY_SIZE, // 16 slots
+    STACK_SLOT = REGISTERS_SLOT + 16, // STACK_SIZE slots
+    I_SLOT = STACK_SLOT + STACK_SIZE,
+    PC_SLOT,
+    SP_SLOT,
+    DELAY_TIMER_SLOT,
+    SOUND_TIMER_SLOT,
+    RANDOM_SLOT,
+    DISPLAY_SLOT // DISPLAY_SIZE slots
+};
+
+uint64_t zobristKey(uint32_t slot, uint32_t value)
+{
+    // Zero values hash to 0, so a zeroed machine contributes nothing.
+    // Instead of a random table (which would need 4096 * 256 entries for the
+    // memory alone) the key is computed on the fly with splitmix64
+    if (value == 0)
+        return 0;
+
+    uint64_t z = (static_cast<uint64_t>(slot) << 32 | value) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+} // namespace
+
 Chip8::Chip8()
+    : Chip8(std::chrono::system_clock::now().time_since_epoch().count())
+{
+}
+
+Chip8::Chip8(unsigned seed)
 {
     // Load the fontset into memory
     for (uint8_t i = 0; i < FONTSET_SIZE; i++)
         m_memory[FONTSET_START_ADDRESS + i] = chip8Fontset[i];
 
-    // Initialize random seed
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    generator = std::default_random_engine(seed);
+    // Initialize random seed (a fixed seed makes the run reproducible)
+    generator = std::minstd_rand(seed);
+    m_randomState = seed % std::minstd_rand::modulus;
+    if (m_randomState == 0)
+        m_randomState = 1; // What the engine does with a zero seed
+
+    // The only full scan of the state, every later write updates the hash
+    m_stateHash = computeStateHash();
+}
+
+uint64_t Chip8::computeStateHash() const
+{
+    // The keypad is input rather than state, and stack entries above the
+    // stack pointer are dead, so neither of them is part of the hash
+    uint64_t hash = 0;
+
+    for (int i = 0; i < MEMORY_SIZE; i++)
+        hash ^= zobristKey(MEMORY_SLOT + i, m_memory[i]);
+    for (int i = 0; i < 16; i++)
+        hash ^= zobristKey(REGISTERS_SLOT + i, m_registers[i]);
+    for (int i = 0; i < m_sp; i++)
+        hash ^= zobristKey(STACK_SLOT + i, m_stack[i]);
+    for (int i = 0; i < DISPLAY_SIZE; i++)
+        if (m_display[i])
+            hash ^= zobristKey(DISPLAY_SLOT + i, 1);
+
+    hash ^= zobristKey(I_SLOT, m_I);
+    hash ^= zobristKey(PC_SLOT, m_pc);
+    hash ^= zobristKey(SP_SLOT, m_sp);
+    hash ^= zobristKey(DELAY_TIMER_SLOT, m_delayTimer);
+    hash ^= zobristKey(SOUND_TIMER_SLOT, m_soundTimer);
+    hash ^= zobristKey(RANDOM_SLOT, m_randomState);
+
+    return hash;
+}
+
+void Chip8::saveState(State &state) const
+{
+    std::memcpy(state.memory, m_memory, sizeof(m_memory));
+    std::memcpy(state.registers, m_registers, sizeof(m_registers));
+    state.I = m_I;
+    state.pc = m_pc;
+    state.sp = m_sp;
+    state.delayTimer = m_delayTimer;
+    state.soundTimer = m_soundTimer;
+    state.randomState = m_randomState;
+    std::memcpy(state.stack, m_stack, sizeof(m_stack));
+    std::memcpy(state.display, m_display, sizeof(m_display));
+}
+
+void Chip8::setMemory(uint16_t address, uint8_t value)
+{
+    // Addresses past the end of the memory wrap around
+    address &= MEMORY_SIZE - 1;
+    m_stateHash ^= zobristKey(MEMORY_SLOT + address, m_memory[address]) ^ zobristKey(MEMORY_SLOT + address, value);
+    m_memory[address] = value;
+}
+
+void Chip8::setRegister(uint8_t index, uint8_t value)
+{
+    m_stateHash ^= zobristKey(REGISTERS_SLOT + index, m_registers[index]) ^ zobristKey(REGISTERS_SLOT + index, value);
+    m_registers[index] = value;
+}
+
+void Chip8::setI(uint16_t value)
+{
+    m_stateHash ^= zobristKey(I_SLOT, m_I) ^ zobristKey(I_SLOT, value);
+    m_I = value;
+}
+
+void Chip8::setPc(uint16_t value)
+{
+    m_stateHash ^= zobristKey(PC_SLOT, m_pc) ^ zobristKey(PC_SLOT, value);
+    m_pc = value;
+}
+
+void Chip8::setDelayTimer(uint8_t value)
+{
+    m_stateHash ^= zobristKey(DELAY_TIMER_SLOT, m_delayTimer) ^ zobristKey(DELAY_TIMER_SLOT, value);
+    m_delayTimer = value;
+}
+
+void Chip8::setSoundTimer(uint8_t value)
+{
+    m_stateHash ^= zobristKey(SOUND_TIMER_SLOT, m_soundTimer) ^ zobristKey(SOUND_TIMER_SLOT, value);
+    m_soundTimer = value;
+}
+
+uint8_t Chip8::nextRandom()
+{
+    uint32_t state = generator();
+    m_stateHash ^= zobristKey(RANDOM_SLOT, m_randomState) ^ zobristKey(RANDOM_SLOT, state);
+    m_randomState = state;
+
+    // The state is below 2^31, its top 8 bits are the most random ones
+    return state >> 23;
+}
+
+void Chip8::push(uint16_t value)
+{
+    m_stateHash ^= zobristKey(SP_SLOT, m_sp) ^ zobristKey(SP_SLOT, m_sp + 1);
+    m_stateHash ^= zobristKey(STACK_SLOT + m_sp, value);
+    m_stack[m_sp++] = value;
+}
+
+uint16_t Chip8::pop()
+{
+    m_stateHash ^= zobristKey(SP_SLOT, m_sp) ^ zobristKey(SP_SLOT, m_sp - 1);
+    m_sp--;
+    m_stateHash ^= zobristKey(STACK_SLOT + m_sp, m_stack[m_sp]);
+    return m_stack[m_sp];
+}
+
+bool Chip8::flipPixel(int index)
+{
+    // Xors the pixel on the screen and returns true if it was already set.
+    // Sprites drawn past the bottom of the screen wrap around to the top
+    index &= DISPLAY_SIZE - 1;
+    bool wasSet = m_display[index] == 0xFFFFFFFF;
+    m_stateHash ^= zobristKey(DISPLAY_SLOT + index, 1);
+    m_display[index] ^= 0xFFFFFFFF;
+    return wasSet;
+}
+
+void Chip8::fault(char const *what, uint16_t opcode)
+{
+    m_faults++;
+    if (m_logFaults)
+        std::cout << what << ": " << std::hex << opcode << std::dec << std::endl;
 }
 
 void Chip8::loadGame(char const *filename)
@@ -33,18 +198,28 @@ void Chip8::loadGame(char const *filename)
     long size = file.tellg();
     file.seekg(0, std::ios::beg);
     for (auto i = 0; i < size; i++)
-        m_memory[START_ADDRESS + i] = file.get();
+        setMemory(START_ADDRESS + i, file.get());
 
     file.close();
 }
 
+void Chip8::loadGame(uint8_t const *data, std::size_t size)
+{
+    // Copy the ROM into the memory, anything that does not fit is dropped
+    if (size > sizeof(m_memory) - START_ADDRESS)
+        size = sizeof(m_memory) - START_ADDRESS;
+
+    for (std::size_t i = 0; i < size; i++)
+        setMemory(START_ADDRESS + i, data[i]);
+}
+
 void Chip8::cycle()
 {
     // Fetch the opcode
-    m_opcode = m_memory[m_pc] << 8 | m_memory[m_pc + 1];
+    m_opcode = m_memory[m_pc & (MEMORY_SIZE - 1)] << 8 | m_memory[(m_pc + 1) & (MEMORY_SIZE - 1)];
 
     // Increment the program counter
-    m_pc += 2;
+    setPc(m_pc + 2);
 
     // Debugging purposes
     // std::cout << "opcode: " << std::hex << opcode << std::endl;
@@ -70,13 +245,13 @@ void Chip8::cycle()
         case 0xE000: decodeOpcodeE(m_opcode); break;
         case 0xF000: decodeOpcodeF(m_opcode); break;
         default:
-            std::cout << "Unknown opcode: " << std::hex << m_opcode << std::endl;
+            fault("Unknown opcode", m_opcode);
             break;
     }
 
     // Update timers
-    if (m_delayTimer > 0) m_delayTimer--;
-    if (m_soundTimer > 0) m_soundTimer--;
+    if (m_delayTimer > 0) setDelayTimer(m_delayTimer - 1);
+    if (m_soundTimer > 0) setSoundTimer(m_soundTimer - 1);
 }
 
 void Chip8::decodeOpcode0(uint16_t opcode)
@@ -87,7 +262,7 @@ void Chip8::decodeOpcode0(uint16_t opcode)
         case 0x0000: executeOpcode00E0(); break;
         case 0x000E: executeOpcode00EE(); break;
         default:
-            std::cout << "Unknown opcode: " << std::hex << opcode << std::endl;
+            fault("Unknown opcode", opcode);
             break;
     }
 }
@@ -95,27 +270,40 @@ void Chip8::decodeOpcode0(uint16_t opcode)
 void Chip8::executeOpcode00E0()
 {
     // Clears the screen
-    for (uint32_t &i: m_display)
-        i = 0;
+    for (int i = 0; i < DISPLAY_SIZE; i++)
+        if (m_display[i])
+            flipPixel(i);
 }
 
 void Chip8::executeOpcode00EE()
 {
     // Returns from a subroutine
-    m_pc = m_stack[--m_sp];
+    if (m_sp == 0)
+    {
+        fault("Stack underflow", 0x00EE);
+        return;
+    }
+
+    setPc(pop());
 }
 
 void Chip8::executeOpcode1NNN(uint16_t opcode)
 {
     // Jumps to address NNN
-    m_pc = opcode & 0x0FFF;
+    setPc(opcode & 0x0FFF);
 }
 
 void Chip8::executeOpcode2NNN(uint16_t opcode)
 {
     // Calls subroutine at NNN
-    m_stack[m_sp++] = m_pc;
-    m_pc = opcode & 0x0FFF;
+    if (m_sp == STACK_SIZE)
+    {
+        fault("Stack overflow", opcode);
+        return;
+    }
+
+    push(m_pc);
+    setPc(opcode & 0x0FFF);
 }
 
 void Chip8::executeOpcode3XNN(uint16_t opcode)
@@ -125,7 +313,7 @@ void Chip8::executeOpcode3XNN(uint16_t opcode)
     uint8_t NN = opcode & 0x00FF;
 
     if (m_registers[VX] == NN)
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::executeOpcode4XNN(uint16_t opcode)
@@ -135,7 +323,7 @@ void Chip8::executeOpcode4XNN(uint16_t opcode)
     uint8_t NN = opcode & 0x00FF;
 
     if (m_registers[VX] != NN)
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::executeOpcode5XY0(uint16_t opcode)
@@ -145,7 +333,7 @@ void Chip8::executeOpcode5XY0(uint16_t opcode)
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
     if (m_registers[VX] == m_registers[VY])
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::executeOpcode6XNN(uint16_t opcode)
@@ -154,7 +342,7 @@ void Chip8::executeOpcode6XNN(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t NN = opcode & 0x00FF;
 
-    m_registers[VX] = NN;
+    setRegister(VX, NN);
 }
 
 void Chip8::executeOpcode7XNN(uint16_t opcode)
@@ -163,7 +351,7 @@ void Chip8::executeOpcode7XNN(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t NN = opcode & 0x00FF;
 
-    m_registers[VX] += NN;
+    setRegister(VX, m_registers[VX] + NN);
 }
 
 void Chip8::decodeOpcode8(uint16_t opcode)
@@ -181,7 +369,7 @@ void Chip8::decodeOpcode8(uint16_t opcode)
         case 0x0007: executeOpcode8XY7(opcode); break;
         case 0x000E: executeOpcode8XYE(opcode); break;
         default:
-            std::cout << "Unknown opcode: " << std::hex << opcode << std::endl;
+            fault("Unknown opcode", opcode);
             break;
     }
 }
@@ -192,7 +380,7 @@ void Chip8::executeOpcode8XY0(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
-    m_registers[VX] = m_registers[VY];
+    setRegister(VX, m_registers[VY]);
 }
 
 void Chip8::executeOpcode8XY1(uint16_t opcode)
@@ -201,7 +389,7 @@ void Chip8::executeOpcode8XY1(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
-    m_registers[VX] |= m_registers[VY];
+    setRegister(VX, m_registers[VX] | m_registers[VY]);
 }
 
 void Chip8::executeOpcode8XY2(uint16_t opcode)
@@ -210,7 +398,7 @@ void Chip8::executeOpcode8XY2(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
-    m_registers[VX] &= m_registers[VY];
+    setRegister(VX, m_registers[VX] & m_registers[VY]);
 }
 
 void Chip8::executeOpcode8XY3(uint16_t opcode)
@@ -219,7 +407,7 @@ void Chip8::executeOpcode8XY3(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
-    m_registers[VX] ^= m_registers[VY];
+    setRegister(VX, m_registers[VX] ^ m_registers[VY]);
 }
 
 void Chip8::executeOpcode8XY4(uint16_t opcode)
@@ -231,11 +419,11 @@ void Chip8::executeOpcode8XY4(uint16_t opcode)
     uint16_t sum = m_registers[VX] + m_registers[VY];
 
     if (sum > 255)
-        m_registers[0xF] = 1;
+        setRegister(0xF, 1);
     else
-        m_registers[0xF] = 0;
+        setRegister(0xF, 0);
 
-    m_registers[VX] = sum & 0xFF;
+    setRegister(VX, sum & 0xFF);
 }
 
 void Chip8::executeOpcode8XY5(uint16_t opcode)
@@ -245,11 +433,11 @@ void Chip8::executeOpcode8XY5(uint16_t opcode)
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
     if (m_registers[VX] > m_registers[VY])
-        m_registers[0xF] = 1;
+        setRegister(0xF, 1);
     else
-        m_registers[0xF] = 0;
+        setRegister(0xF, 0);
 
-    m_registers[VX] -= m_registers[VY];
+    setRegister(VX, m_registers[VX] - m_registers[VY]);
 }
 
 void Chip8::executeOpcode8XY6(uint16_t opcode)
@@ -257,8 +445,8 @@ void Chip8::executeOpcode8XY6(uint16_t opcode)
     // Stores the least significant bit of VX in VF and then shifts VX to the right by 1
     uint8_t VX = (opcode & 0x0F00) >> 8;
 
-    m_registers[0xF] = m_registers[VX] & 0x1;
-    m_registers[VX] >>= 1;
+    setRegister(0xF, m_registers[VX] & 0x1);
+    setRegister(VX, m_registers[VX] >> 1);
 }
 
 void Chip8::executeOpcode8XY7(uint16_t opcode)
@@ -268,11 +456,11 @@ void Chip8::executeOpcode8XY7(uint16_t opcode)
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
     if (m_registers[VY] > m_registers[VX])
-        m_registers[0xF] = 1;
+        setRegister(0xF, 1);
     else
-        m_registers[0xF] = 0;
+        setRegister(0xF, 0);
 
-    m_registers[VX] = m_registers[VY] - m_registers[VX];
+    setRegister(VX, m_registers[VY] - m_registers[VX]);
 }
 
 void Chip8::executeOpcode8XYE(uint16_t opcode)
@@ -280,8 +468,8 @@ void Chip8::executeOpcode8XYE(uint16_t opcode)
     // Stores the most significant bit of VX in VF and then shifts VX to the left by 1
     uint8_t VX = (opcode & 0x0F00) >> 8;
 
-    m_registers[0xF] = (m_registers[VX] >> 7) & 0x1;
-    m_registers[VX] <<= 1;
+    setRegister(0xF, (m_registers[VX] >> 7) & 0x1);
+    setRegister(VX, m_registers[VX] << 1);
 }
 
 void Chip8::executeOpcode9XY0(uint16_t opcode)
@@ -291,13 +479,13 @@ void Chip8::executeOpcode9XY0(uint16_t opcode)
     uint8_t VY = (opcode & 0x00F0) >> 4;
 
     if (m_registers[VX] != m_registers[VY])
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::executeOpcodeANNN(uint16_t opcode)
 {
     // Sets I to the address NNN
-    m_I = opcode & 0x0FFF;
+    setI(opcode & 0x0FFF);
 }
 
 void Chip8::executeOpcodeBNNN(uint16_t opcode)
@@ -305,7 +493,7 @@ void Chip8::executeOpcodeBNNN(uint16_t opcode)
     // Jumps to the address NNN plus V0
     uint16_t NNN = opcode & 0x0FFF;
 
-    m_pc = NNN + m_registers[0];
+    setPc(NNN + m_registers[0]);
 }
 
 void Chip8::executeOpcodeCXNN(uint16_t opcode)
@@ -315,9 +503,7 @@ void Chip8::executeOpcodeCXNN(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
     uint8_t NN = (opcode & 0x00FF);
 
-    std::uniform_int_distribution<uint8_t> distribution(0, 255);
-
-    m_registers[VX] = distribution(generator) & NN; //(rand() % 256) & NN;
+    setRegister(VX, nextRandom() & NN); //(rand() % 256) & NN;
 }
 
 void Chip8::executeOpcodeDXYN(uint16_t opcode)
@@ -340,22 +526,19 @@ void Chip8::executeOpcodeDXYN(uint16_t opcode)
 
     for (uint8_t row = 0; row < N; row++)
     {
-        pixel = m_memory[m_I + row];
+        pixel = m_memory[(m_I + row) & (MEMORY_SIZE - 1)];
 
         for (uint8_t col = 0; col < 8; col++)
         {
             // If the pixel is set, draw it to the screen
             if ((pixel & (0x80 >> col)) != 0)
             {
-                auto *pixel_ptr = static_cast<uint32_t *>(&m_display[(y + row) * SCREEN_WIDTH + (x + col)]);
-                // If the pixel on the screen is already set, set VF to 1, else set it to 0
-                if (*pixel_ptr == 0xFFFFFFFF)
-                    m_registers[0xF] = 1;
+                // Xor the pixel on the screen with the pixel of the sprite.
+                // If the pixel on the screen was already set, set VF to 1, else set it to 0
+                if (flipPixel((y + row) * SCREEN_WIDTH + (x + col)))
+                    setRegister(0xF, 1);
                 else
-                    m_registers[0xF] = 0;
-
-                // Xor the pixel on the screen with the pixel of the sprite
-                *pixel_ptr ^= 0xFFFFFFFF;
+                    setRegister(0xF, 0);
             }
         }
     }
@@ -368,7 +551,7 @@ void Chip8::decodeOpcodeE(uint16_t opcode)
         case 0x009E: executeOpcodeEX9E(opcode); break;
         case 0x00A1: executeOpcodeEXA1(opcode); break;
         default:
-            std::cout << "Unknown opcode: " << std::hex << opcode << std::endl;
+            fault("Unknown opcode", opcode);
             break;
     }
 }
@@ -377,20 +560,20 @@ void Chip8::executeOpcodeEX9E(uint16_t opcode)
 {
     // Skips the next instruction if the key stored in VX is pressed
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    uint8_t key = m_registers[VX];
+    uint8_t key = m_registers[VX] & 0xF;
 
     if (m_keypad[key])
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::executeOpcodeEXA1(uint16_t opcode)
 {
     // Skips the next instruction if the key stored in VX is not pressed
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    uint8_t key = m_registers[VX];
+    uint8_t key = m_registers[VX] & 0xF;
 
     if (!m_keypad[key])
-        m_pc += 2;
+        setPc(m_pc + 2);
 }
 
 void Chip8::decodeOpcodeF(uint16_t opcode)
@@ -407,7 +590,7 @@ void Chip8::decodeOpcodeF(uint16_t opcode)
         case 0x0055: executeOpcodeFX55(opcode); break;
         case 0x0065: executeOpcodeFX65(opcode); break;
         default:
-            std::cout << "Unknown opcode: " << std::hex << opcode << std::endl;
+            fault("Unknown opcode", opcode);
             break;
     }
 }
@@ -416,7 +599,7 @@ void Chip8::executeOpcodeFX07(uint16_t opcode)
 {
     // Sets VX to the value of the delay timer
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    m_registers[VX] = m_delayTimer;
+    setRegister(VX, m_delayTimer);
 }
 
 void Chip8::executeOpcodeFX0A(uint16_t opcode)
@@ -428,33 +611,33 @@ void Chip8::executeOpcodeFX0A(uint16_t opcode)
     for (uint8_t i: m_keypad)
         if (i)
         {
-            m_registers[VX] = i;
+            setRegister(VX, i);
             return;
         }
 
     // If no key is pressed, pc is not incremented
-    m_pc -= 2;
+    setPc(m_pc - 2);
 }
 
 void Chip8::executeOpcodeFX15(uint16_t opcode)
 {
     // Sets the delay timer to VX
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    m_delayTimer = m_registers[VX];
+    setDelayTimer(m_registers[VX]);
 }
 
 void Chip8::executeOpcodeFX18(uint16_t opcode)
 {
     // Sets the sound timer to VX
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    m_soundTimer = m_registers[VX];
+    setSoundTimer(m_registers[VX]);
 }
 
 void Chip8::executeOpcodeFX1E(uint16_t opcode)
 {
     // Adds VX to I. VF is not affected
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    m_I += m_registers[VX];
+    setI(m_I + m_registers[VX]);
 }
 
 void Chip8::executeOpcodeFX29(uint16_t opcode)
@@ -462,7 +645,7 @@ void Chip8::executeOpcodeFX29(uint16_t opcode)
     // Sets I to the location of the sprite for the character in VX.
     // Characters 0-F (in hexadecimal) are represented by a 4x5 font.
     uint8_t VX = (opcode & 0x0F00) >> 8;
-    m_I = FONTSET_START_ADDRESS + m_registers[VX] * 5;
+    setI(FONTSET_START_ADDRESS + m_registers[VX] * 5);
 }
 
 void Chip8::executeOpcodeFX33(uint16_t opcode)
@@ -483,9 +666,9 @@ void Chip8::executeOpcodeFX33(uint16_t opcode)
     uint8_t tens = (value % 100) / 10;
     uint8_t ones = value % 10;
 
-    m_memory[m_I] = hundreds;
-    m_memory[m_I + 1] = tens;
-    m_memory[m_I + 2] = ones;
+    setMemory(m_I, hundreds);
+    setMemory(m_I + 1, tens);
+    setMemory(m_I + 2, ones);
 }
 
 void Chip8::executeOpcodeFX55(uint16_t opcode)
@@ -497,7 +680,7 @@ void Chip8::executeOpcodeFX55(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
 
     for (uint8_t i = 0; i <= VX; i++)
-        m_memory[m_I + i] = m_registers[i];
+        setMemory(m_I + i, m_registers[i]);
 }
 
 void Chip8::executeOpcodeFX65(uint16_t opcode)
@@ -509,6 +692,6 @@ void Chip8::executeOpcodeFX65(uint16_t opcode)
     uint8_t VX = (opcode & 0x0F00) >> 8;
 
     for (uint8_t i = 0; i <= VX; i++)
-        m_registers[i] = m_memory[m_I + i];
+        setRegister(i, m_memory[(m_I + i) & (MEMORY_SIZE - 1)]);
 }
 } // namespace chip8
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <random>
 #include <string>
@@ -9,6 +10,8 @@ namespace chip8
 constexpr int SCREEN_WIDTH = 64;
 constexpr int SCREEN_HEIGHT = 32;
 constexpr int DISPLAY_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT; // 2048 pixels
+constexpr int MEMORY_SIZE = 4096;
+constexpr int STACK_SIZE = 16;
 constexpr int FONTSET_SIZE = 80;
 constexpr uint8_t chip8Fontset[FONTSET_SIZE] = {
         // Every charater is 4 pixels wide and 5 pixels high
@@ -36,27 +39,76 @@ const uint16_t FONTSET_START_ADDRESS = 0x50; // Fontset starts at 0x50
 class Chip8
 {
 private:
-    uint8_t m_memory[4096]{}; // 4K memory
+    uint8_t m_memory[MEMORY_SIZE]{}; // 4K memory
     uint8_t m_registers[16]{}; // V0-VF
     uint16_t m_I = 0; // Index register
     uint16_t m_pc = 0x200; // Program counter
     uint16_t m_opcode = 0; // Current opcode
     uint8_t m_delayTimer = 0; // Delay timer
     uint8_t m_soundTimer = 0; // Sound timer
-    uint16_t m_stack[16]{}; // Stack
+    uint16_t m_stack[STACK_SIZE]{}; // Stack
     uint16_t m_sp = 0; // Stack pointer
+    uint64_t m_stateHash = 0; // Zobrist hash of the machine state, updated on every write
 
-    std::default_random_engine generator;
+    // minstd_rand returns its new state on every draw, which lets the hash
+    // follow the generator: two machines with the same registers, memory and
+    // display but at different points of the random sequence hash differently
+    std::minstd_rand generator;
+    uint32_t m_randomState = 0; // State of the generator, kept for the hash
+    uint64_t m_faults = 0; // Unknown opcodes and stack overflows/underflows so far
+    bool m_logFaults = false; // Print faults on stdout
+
+    // Every write to the hashed state goes through these, so that the hash is
+    // kept up to date without rescanning the whole machine
+    void setMemory(uint16_t address, uint8_t value);
+    void setRegister(uint8_t index, uint8_t value);
+    void setI(uint16_t value);
+    void setPc(uint16_t value);
+    void setDelayTimer(uint8_t value);
+    void setSoundTimer(uint8_t value);
+    void push(uint16_t value);
+    uint16_t pop();
+    bool flipPixel(int index);
+    uint8_t nextRandom();
+    void fault(char const *what, uint16_t opcode);
 
 public:
     uint32_t m_display[DISPLAY_SIZE]{}; // Graphics array (64x32)
     uint8_t m_keypad[16]{}; // Keypad
 
+    // Snapshot of the machine state, to compare execution engines
+    struct State
+    {
+        uint8_t memory[MEMORY_SIZE];
+        uint8_t registers[16];
+        uint16_t I;
+        uint16_t pc;
+        uint16_t sp;
+        uint8_t delayTimer;
+        uint8_t soundTimer;
+        uint32_t randomState;
+        uint16_t stack[STACK_SIZE];
+        uint32_t display[DISPLAY_SIZE];
+    };
+
     Chip8();
+    explicit Chip8(unsigned seed);
 
     void loadGame(char const *filename);
+    void loadGame(uint8_t const *data, std::size_t size);
     void cycle();
 
+    // Covers memory, registers, I, PC, the live stack, timers, display and the
+    // random generator. The keypad is input and is not part of it
+    uint64_t stateHash() const { return m_stateHash; }
+    uint64_t computeStateHash() const;
+    void saveState(State &state) const;
+
+    // Faulting instructions are ignored and counted. They are only printed if
+    // enabled, since headless hosts run ROMs they don't control
+    uint64_t faults() const { return m_faults; }
+    void setLogFaults(bool logFaults) { m_logFaults = logFaults; }
+
     void decodeOpcode0(uint16_t opcode);
     void executeOpcode00E0();
     void executeOpcode00EE();
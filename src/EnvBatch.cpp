@@ -0,0 +1,154 @@
+#include "EnvBatch.h"
+#include "Frame.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace chip8
+{
+namespace
+{
+constexpr std::size_t SEEN_STATES_CAPACITY = 1 << 20;
+} // namespace
+
+std::size_t observationSize(ObservationFormat format)
+{
+    switch (format)
+    {
+        case ObservationFormat::Packed1bpp: return PACKED_FRAME_SIZE;
+        case ObservationFormat::Downsampled8bit: return DOWNSAMPLED_FRAME_SIZE;
+    }
+    return 0;
+}
+
+EnvBatch::EnvBatch(int count, int cyclesPerFrame, unsigned seed)
+    : m_cyclesPerFrame(cyclesPerFrame), m_seed(seed)
+{
+    m_machines.reserve(count);
+    for (int i = 0; i < count; i++)
+        m_machines.emplace_back(seed + i);
+}
+
+EnvBatch::~EnvBatch()
+{
+    detach();
+}
+
+bool EnvBatch::loadRom(uint8_t const *data, std::size_t size)
+{
+    if (size > MEMORY_SIZE - START_ADDRESS)
+        return false;
+
+    m_rom.assign(data, data + size);
+    resetAll();
+    return true;
+}
+
+void EnvBatch::reset(int index)
+{
+    // Every environment restarts from the same seed, so episodes are reproducible
+    m_machines[index] = Chip8(m_seed + index);
+    m_machines[index].loadGame(m_rom.data(), m_rom.size());
+}
+
+void EnvBatch::resetAll()
+{
+    for (int i = 0; i < size(); i++)
+        reset(i);
+}
+
+void EnvBatch::step(uint16_t const *actions, int frames)
+{
+    for (int i = 0; i < size(); i++)
+    {
+        Chip8 &machine = m_machines[i];
+
+        for (int key = 0; key < 16; key++)
+            machine.m_keypad[key] = (actions[i] >> key) & 0x1;
+
+        int64_t cycles = static_cast<int64_t>(frames) * m_cyclesPerFrame;
+        for (int64_t cycle = 0; cycle < cycles; cycle++)
+            machine.cycle();
+    }
+
+    if (m_observations)
+        observe(m_observations, m_observationFormat);
+}
+
+void EnvBatch::observe(uint8_t *out, ObservationFormat format) const
+{
+    std::size_t stride = observationSize(format);
+
+    for (int i = 0; i < size(); i++)
+    {
+        if (format == ObservationFormat::Packed1bpp)
+            packDisplay(m_machines[i].m_display, out + i * stride);
+        else
+            downsampleDisplay(m_machines[i].m_display, out + i * stride);
+    }
+}
+
+bool EnvBatch::attachBuffer(void *buffer, std::size_t size, ObservationFormat format)
+{
+    if (size < observationSize(format) * m_machines.size())
+        return false;
+
+    detach();
+    m_observations = static_cast<uint8_t *>(buffer);
+    m_observationFormat = format;
+    return true;
+}
+
+void *EnvBatch::attachSharedMemory(char const *name, ObservationFormat format)
+{
+    // The other process opens the same POSIX shared memory object and reads
+    // the observations in place
+    std::size_t size = observationSize(format) * m_machines.size();
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+
+    if (ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        return nullptr;
+
+    attachBuffer(memory, size, format);
+    m_sharedMemory = memory;
+    m_sharedMemorySize = size;
+    return memory;
+}
+
+void EnvBatch::detach()
+{
+    if (m_sharedMemory)
+        munmap(m_sharedMemory, m_sharedMemorySize);
+
+    m_sharedMemory = nullptr;
+    m_sharedMemorySize = 0;
+    m_observations = nullptr;
+}
+
+void EnvBatch::stateHashes(uint64_t *out) const
+{
+    for (int i = 0; i < size(); i++)
+        out[i] = m_machines[i].stateHash();
+}
+
+void EnvBatch::novelStates(uint8_t *out)
+{
+    if (!m_seenStates)
+        m_seenStates.reset(new TranspositionTable(SEEN_STATES_CAPACITY));
+
+    for (int i = 0; i < size(); i++)
+        out[i] = m_seenStates->insert(m_machines[i].stateHash());
+}
+} // namespace chip8
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Chip8.h"
+#include "TranspositionTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace chip8
+{
+enum class ObservationFormat
+{
+    Packed1bpp, // PACKED_FRAME_SIZE bytes per environment
+    Downsampled8bit // DOWNSAMPLED_FRAME_SIZE bytes per environment
+};
+
+std::size_t observationSize(ObservationFormat format);
+
+// A vector of emulators stepped together, for training loops driving many
+// environments at once. Backs the C API in chip8_env.h
+class EnvBatch
+{
+public:
+    EnvBatch(int count, int cyclesPerFrame, unsigned seed);
+    ~EnvBatch();
+    EnvBatch(EnvBatch const &) = delete;
+    EnvBatch &operator=(EnvBatch const &) = delete;
+
+    bool loadRom(uint8_t const *data, std::size_t size);
+    void reset(int index);
+    void resetAll();
+
+    // Holds actions[i] (bit k = key k pressed) on environment i for the
+    // given number of frames, then writes the observations to the attached
+    // buffer, if any
+    void step(uint16_t const *actions, int frames);
+
+    void observe(uint8_t *out, ObservationFormat format) const;
+    bool attachBuffer(void *buffer, std::size_t size, ObservationFormat format);
+    void *attachSharedMemory(char const *name, ObservationFormat format);
+    void detach();
+
+    void stateHashes(uint64_t *out) const;
+    void novelStates(uint8_t *out); // 1 if the state of the environment has never been seen
+
+    int size() const { return static_cast<int>(m_machines.size()); }
+    Chip8 const &machine(int index) const { return m_machines[index]; }
+
+private:
+    std::vector<Chip8> m_machines;
+    std::vector<uint8_t> m_rom; // Kept to reload the machines on reset
+    int m_cyclesPerFrame;
+    unsigned m_seed;
+
+    uint8_t *m_observations = nullptr; // Attached buffer, written after every step
+    ObservationFormat m_observationFormat = ObservationFormat::Packed1bpp;
+    void *m_sharedMemory = nullptr; // Set if the buffer was mapped by attachSharedMemory
+    std::size_t m_sharedMemorySize = 0;
+
+    std::unique_ptr<TranspositionTable> m_seenStates; // Created by the first novelStates call
+};
+} // namespace chip8
@@ -0,0 +1,40 @@
+#include "Frame.h"
+
+namespace chip8
+{
+void packRow(uint32_t const *display, int row, uint8_t *out)
+{
+    uint32_t const *pixels = display + row * SCREEN_WIDTH;
+
+    for (int byte = 0; byte < PACKED_ROW_SIZE; byte++)
+    {
+        uint8_t bits = 0;
+        for (int bit = 0; bit < 8; bit++)
+            if (pixels[byte * 8 + bit])
+                bits |= 0x80 >> bit;
+
+        out[byte] = bits;
+    }
+}
+
+void packDisplay(uint32_t const *display, uint8_t *out)
+{
+    for (int row = 0; row < SCREEN_HEIGHT; row++)
+        packRow(display, row, out + row * PACKED_ROW_SIZE);
+}
+
+void downsampleDisplay(uint32_t const *display, uint8_t *out)
+{
+    for (int y = 0; y < DOWNSAMPLED_HEIGHT; y++)
+    {
+        uint32_t const *top = display + (y * 2) * SCREEN_WIDTH;
+        uint32_t const *bottom = top + SCREEN_WIDTH;
+
+        for (int x = 0; x < DOWNSAMPLED_WIDTH; x++)
+        {
+            int set = (top[x * 2] != 0) + (top[x * 2 + 1] != 0) + (bottom[x * 2] != 0) + (bottom[x * 2 + 1] != 0);
+            out[y * DOWNSAMPLED_WIDTH + x] = set * 255 / 4;
+        }
+    }
+}
+} // namespace chip8
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Chip8.h"
+
+#include <cstdint>
+
+namespace chip8
+{
+constexpr int PACKED_ROW_SIZE = SCREEN_WIDTH / 8; // 8 bytes per row
+constexpr int PACKED_FRAME_SIZE = PACKED_ROW_SIZE * SCREEN_HEIGHT; // 256 bytes
+constexpr int DOWNSAMPLED_WIDTH = SCREEN_WIDTH / 2;
+constexpr int DOWNSAMPLED_HEIGHT = SCREEN_HEIGHT / 2;
+constexpr int DOWNSAMPLED_FRAME_SIZE = DOWNSAMPLED_WIDTH * DOWNSAMPLED_HEIGHT; // 512 bytes
+
+// Packs a row of the display into 1 bit per pixel, most significant bit first
+void packRow(uint32_t const *display, int row, uint8_t *out);
+
+// Packs the whole display into 1 bit per pixel, row by row
+void packDisplay(uint32_t const *display, uint8_t *out);
+
+// Downsamples the display to 32x16, each byte is the average of a 2x2 block (0-255)
+void downsampleDisplay(uint32_t const *display, uint8_t *out);
+} // namespace chip8
@@ -26,7 +26,12 @@ void Platform::Update(void const *buffer, int pitch)
     SDL_RenderPresent(renderer);
 }
 
-bool Platform::ProcessInput(uint8_t *keys)
+void Platform::SetTitle(char const *title)
+{
+    SDL_SetWindowTitle(window, title);
+}
+
+bool Platform::ProcessInput(uint8_t *keys, bool &turbo)
 {
     bool quit = false;
     SDL_Event event;
@@ -41,6 +46,9 @@ bool Platform::ProcessInput(uint8_t *keys)
                 switch (event.key.keysym.sym)
                 {
                     case SDLK_ESCAPE: quit = true; break;
+                    case SDLK_TAB:
+                        if (!event.key.repeat) turbo = !turbo;
+                        break;
                     case SDLK_x: keys[0] = 1; break;
                     case SDLK_1: keys[1] = 1; break;
                     case SDLK_2: keys[2] = 1; break;
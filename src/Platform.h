@@ -11,7 +11,8 @@ public:
     Platform(char const *title, int windowWidth, int windowHeight, int textureWidth, int textureHeight);
     ~Platform();
     void Update(void const *buffer, int pitch);
-    static bool ProcessInput(uint8_t *keys);
+    void SetTitle(char const *title);
+    static bool ProcessInput(uint8_t *keys, bool &turbo);
 
 private:
     SDL_Window *window{};
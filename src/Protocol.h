@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chip8
+{
+namespace protocol
+{
+/* Binary protocol of the server (see Server.h). Every message, in both
+ * directions, is a MessageHeader followed by length bytes of payload.
+ * Integers are in the byte order of the host, the socket being local.
+ *
+ * Requests:
+ *   CREATE    uint32_t     cycles per frame, 1 if omitted, as in
+ *                          chip8_env_create -> CREATED, the header carries
+ *                          the new session id
+ *   LOAD_ROM  ROM bytes    (no reply)
+ *   INPUT     uint16_t     keypad bitmask, bit k = key k pressed (no reply)
+ *   STEP      uint32_t     frames to run, at most MAX_CYCLES_PER_STEP
+ *                          cycles in total -> FRAME_DELTA
+ *   DESTROY                (no reply)
+ *
+ * Replies:
+ *   CREATED
+ *   FRAME_DELTA  uint32_t mask of the rows changed since the last
+ *                FRAME_DELTA of the session, followed by each changed row
+ *                packed at 1 bit per pixel (PACKED_ROW_SIZE bytes)
+ *   ERROR        uint8_t type of the request that failed
+ *
+ * The sessions of a connection run in parallel, so the replies of different
+ * sessions can come in any order. The requests of a session are handled,
+ * and replied to, in the order they were sent.
+ */
+enum MessageType : uint8_t
+{
+    CREATE = 0x01,
+    LOAD_ROM = 0x02,
+    INPUT = 0x03,
+    STEP = 0x04,
+    DESTROY = 0x05,
+
+    CREATED = 0x81,
+    FRAME_DELTA = 0x82,
+    ERROR = 0x83
+};
+
+struct MessageHeader
+{
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t session;
+    uint32_t length; // Bytes of payload after the header
+};
+static_assert(sizeof(MessageHeader) == 8, "MessageHeader must be packed");
+
+constexpr uint32_t MAX_PAYLOAD = 4096; // Largest request accepted
+constexpr uint32_t MAX_CYCLES_PER_FRAME = 1 << 16;
+constexpr uint64_t MAX_CYCLES_PER_STEP = 1 << 22; // Bounds the time a STEP holds a worker
+} // namespace protocol
+} // namespace chip8
@@ -0,0 +1,474 @@
+#include "Server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chip8
+{
+using protocol::MessageHeader;
+
+namespace
+{
+constexpr int MAX_EVENTS = 64;
+constexpr std::size_t MAX_INPUT = 1 << 20; // Stop reading from a client that is too far ahead
+constexpr std::size_t MAX_OUTPUT = 1 << 20; // Stop handling requests of a client that doesn't read its replies
+
+void appendMessage(std::vector<uint8_t> &out, uint8_t type, uint16_t session, void const *payload, uint32_t length)
+{
+    MessageHeader header{type, 0, session, length};
+    auto const *headerBytes = reinterpret_cast<uint8_t const *>(&header);
+    auto const *payloadBytes = static_cast<uint8_t const *>(payload);
+
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+    out.insert(out.end(), payloadBytes, payloadBytes + length);
+}
+
+// Reads an integer payload, missing bytes being 0
+template<typename T>
+T readPayload(uint8_t const *payload, uint32_t length, T value)
+{
+    if (length > 0)
+    {
+        value = 0;
+        std::memcpy(&value, payload, std::min<uint32_t>(length, sizeof(value)));
+    }
+    return value;
+}
+} // namespace
+
+Server::Server(std::string socketPath, int threads)
+    : m_socketPath(std::move(socketPath)), m_threads(threads)
+{
+}
+
+Server::~Server()
+{
+    // Let the workers finish before the sessions they use go away
+    m_pool.reset();
+
+    for (auto &connection: m_connections)
+        ::close(connection.first);
+
+    if (m_listenFd >= 0)
+    {
+        ::close(m_listenFd);
+        unlink(m_socketPath.c_str());
+    }
+    if (m_epollFd >= 0) ::close(m_epollFd);
+    if (m_wakeUpFd >= 0) ::close(m_wakeUpFd);
+}
+
+bool Server::start()
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path too long: " << m_socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, m_socketPath.c_str());
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(m_socketPath.c_str());
+    if (m_listenFd < 0 || bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(m_listenFd, SOMAXCONN) != 0)
+    {
+        std::cerr << "Could not listen on " << m_socketPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeUpFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeUpFd < 0)
+    {
+        std::cerr << "Could not create the event loop: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_listenFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event);
+    event.data.fd = m_wakeUpFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeUpFd, &event);
+
+    m_pool.reset(new ThreadPool(m_threads));
+    return true;
+}
+
+void Server::run()
+{
+    epoll_event events[MAX_EVENTS];
+
+    while (!m_stopping)
+    {
+        int count = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+        if (count < 0 && errno != EINTR)
+            break;
+
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == m_listenFd)
+            {
+                accept();
+                continue;
+            }
+
+            if (fd == m_wakeUpFd)
+            {
+                uint64_t value;
+                while (read(m_wakeUpFd, &value, sizeof(value)) > 0) {}
+                finishJobs();
+                continue;
+            }
+
+            auto it = m_connections.find(fd);
+            if (it == m_connections.end())
+                continue;
+            Connection &connection = *it->second;
+
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !connection.readClosed)
+                receive(connection);
+            if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+                send(connection);
+
+            parse(connection);
+            update(connection);
+        }
+    }
+}
+
+void Server::stop()
+{
+    m_stopping = true;
+
+    uint64_t one = 1;
+    if (write(m_wakeUpFd, &one, sizeof(one)) < 0) {}
+}
+
+void Server::accept()
+{
+    while (true)
+    {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        std::unique_ptr<Connection> connection(new Connection);
+        connection->fd = fd;
+        update(*connection);
+        m_connections[fd] = std::move(connection);
+    }
+}
+
+void Server::receive(Connection &connection)
+{
+    uint8_t buffer[16384];
+
+    while (connection.input.size() + connection.queuedBytes < MAX_INPUT)
+    {
+        ssize_t received = read(connection.fd, buffer, sizeof(buffer));
+        if (received > 0)
+            connection.input.insert(connection.input.end(), buffer, buffer + received);
+        else if (received == 0)
+        {
+            // The client is done sending, but still gets the replies to its requests
+            connection.readClosed = true;
+            return;
+        }
+        else if (errno != EINTR)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                connection.broken = true;
+            return;
+        }
+    }
+}
+
+void Server::send(Connection &connection)
+{
+    std::size_t sent = 0;
+    while (sent < connection.output.size() && !connection.broken)
+    {
+        ssize_t written = write(connection.fd, connection.output.data() + sent, connection.output.size() - sent);
+        if (written > 0)
+            sent += written;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+        else if (errno != EINTR)
+            connection.broken = true;
+    }
+
+    if (connection.broken)
+        connection.output.clear();
+    else
+        connection.output.erase(connection.output.begin(), connection.output.begin() + sent);
+}
+
+void Server::parse(Connection &connection)
+{
+    // Create and destroy sessions right away, queue everything else on its
+    // session, so that the requests of a session are handled in order
+    std::size_t offset = 0;
+    while (!connection.broken && connection.output.size() <= MAX_OUTPUT && connection.input.size() - offset >= sizeof(MessageHeader))
+    {
+        MessageHeader header;
+        std::memcpy(&header, connection.input.data() + offset, sizeof(header));
+
+        if (header.length > protocol::MAX_PAYLOAD)
+        {
+            connection.broken = true;
+            break;
+        }
+        if (connection.input.size() - offset < sizeof(header) + header.length)
+            break;
+
+        uint8_t const *message = connection.input.data() + offset;
+        uint8_t const *payload = message + sizeof(header);
+        offset += sizeof(header) + header.length;
+
+        if (header.type == protocol::CREATE)
+        {
+            uint32_t cyclesPerFrame = readPayload<uint32_t>(payload, header.length, 1);
+            if (cyclesPerFrame == 0 || cyclesPerFrame > protocol::MAX_CYCLES_PER_FRAME || connection.sessions.size() >= UINT16_MAX)
+            {
+                appendMessage(connection.output, protocol::ERROR, 0, &header.type, 1);
+                continue;
+            }
+
+            // Skip ids still in use once the counter wraps around (0 is never used)
+            while (connection.nextSession == 0 || connection.sessions.count(connection.nextSession))
+                connection.nextSession++;
+
+            std::unique_ptr<Session> session(new Session);
+            session->connection = &connection;
+            session->id = connection.nextSession++;
+            session->cyclesPerFrame = cyclesPerFrame;
+            appendMessage(connection.output, protocol::CREATED, session->id, nullptr, 0);
+            connection.sessions[session->id] = std::move(session);
+            continue;
+        }
+
+        auto it = connection.sessions.find(header.session);
+        if (it == connection.sessions.end() || it->second->destroying)
+        {
+            appendMessage(connection.output, protocol::ERROR, header.session, &header.type, 1);
+            continue;
+        }
+        Session &session = *it->second;
+
+        if (header.type == protocol::DESTROY)
+        {
+            // Wait for the requests already queued before erasing the session
+            if (session.busy || !session.queued.empty())
+                session.destroying = true;
+            else
+                connection.sessions.erase(it);
+            continue;
+        }
+
+        session.queued.insert(session.queued.end(), message, payload + header.length);
+        connection.queuedBytes += sizeof(header) + header.length;
+        if (!session.busy)
+            schedule(session);
+    }
+
+    connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+}
+
+void Server::schedule(Session &session)
+{
+    session.requests.swap(session.queued);
+    session.busy = true;
+    session.connection->busySessions++;
+
+    Session *job = &session;
+    m_pool->submit([this, job] {
+        handleRequests(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_finishedMutex);
+            m_finished.push_back(job);
+        }
+        uint64_t one = 1;
+        if (write(m_wakeUpFd, &one, sizeof(one)) < 0) {}
+    });
+}
+
+void Server::finishJobs()
+{
+    std::vector<Session *> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        finished.swap(m_finished);
+    }
+
+    // Several sessions of a connection can finish together, the connection
+    // is only closed by the last one
+    for (Session *session: finished)
+    {
+        Connection &connection = *session->connection;
+
+        session->busy = false;
+        connection.busySessions--;
+        connection.queuedBytes -= session->requests.size();
+        session->requests.clear();
+
+        if (!connection.broken)
+            connection.output.insert(connection.output.end(), session->replies.begin(), session->replies.end());
+        session->replies.clear();
+
+        if (!session->queued.empty() && !connection.broken)
+            schedule(*session);
+        else if (session->destroying)
+            connection.sessions.erase(session->id);
+
+        send(connection);
+        parse(connection);
+        update(connection);
+    }
+}
+
+void Server::update(Connection &connection)
+{
+    // A broken connection is closed once no worker uses its sessions, a
+    // closed one once every request has been replied to
+    bool idle = connection.busySessions == 0;
+    bool done = connection.readClosed && idle && connection.queuedBytes == 0 && connection.output.empty();
+    if ((connection.broken && idle) || done)
+    {
+        close(connection);
+        return;
+    }
+
+    // Only ask for the events that can be handled now: a client that is
+    // closing or too far ahead is not read, and being registered for
+    // nothing would still report hang-ups, so the fd is removed instead
+    uint32_t events = 0;
+    if (!connection.readClosed && !connection.broken && connection.input.size() + connection.queuedBytes < MAX_INPUT)
+        events |= EPOLLIN;
+    if (!connection.broken && !connection.output.empty())
+        events |= EPOLLOUT;
+
+    if (events == connection.events)
+        return;
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = connection.fd;
+
+    if (connection.events == 0)
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+    else if (events == 0)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    else
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+
+    connection.events = events;
+}
+
+void Server::close(Connection &connection)
+{
+    int fd = connection.fd;
+
+    if (connection.events != 0)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    m_connections.erase(fd);
+}
+
+void Server::handleRequests(Session &session)
+{
+    std::size_t offset = 0;
+    while (offset < session.requests.size())
+    {
+        MessageHeader header;
+        std::memcpy(&header, session.requests.data() + offset, sizeof(header));
+        offset += sizeof(header);
+
+        handleRequest(session, header, session.requests.data() + offset);
+        offset += header.length;
+    }
+}
+
+void Server::handleRequest(Session &session, MessageHeader const &header, uint8_t const *payload)
+{
+    switch (header.type)
+    {
+        case protocol::LOAD_ROM:
+            if (header.length > MEMORY_SIZE - START_ADDRESS)
+                appendMessage(session.replies, protocol::ERROR, session.id, &header.type, 1);
+            else
+            {
+                // Loading a ROM restarts the session from a fresh machine
+                session.machine = Chip8();
+                session.machine.loadGame(payload, header.length);
+            }
+            break;
+        case protocol::INPUT: {
+            uint16_t keys = readPayload<uint16_t>(payload, header.length, 0);
+            for (int key = 0; key < 16; key++)
+                session.machine.m_keypad[key] = (keys >> key) & 0x1;
+            break;
+        }
+        case protocol::STEP: {
+            uint64_t cycles = static_cast<uint64_t>(readPayload<uint32_t>(payload, header.length, 0)) * session.cyclesPerFrame;
+            if (cycles > protocol::MAX_CYCLES_PER_STEP)
+            {
+                appendMessage(session.replies, protocol::ERROR, session.id, &header.type, 1);
+                break;
+            }
+
+            for (uint64_t i = 0; i < cycles; i++)
+                session.machine.cycle();
+            appendFrameDelta(session, session.replies);
+            break;
+        }
+        default:
+            appendMessage(session.replies, protocol::ERROR, session.id, &header.type, 1);
+            break;
+    }
+}
+
+void Server::appendFrameDelta(Session &session, std::vector<uint8_t> &out)
+{
+    // Only the rows that changed since the last delta are sent, so an idle
+    // session costs a 12 byte reply
+    uint8_t rows[PACKED_FRAME_SIZE];
+    uint32_t changed = 0;
+    int changedCount = 0;
+
+    for (int row = 0; row < SCREEN_HEIGHT; row++)
+    {
+        uint8_t *last = session.lastFrame + row * PACKED_ROW_SIZE;
+        uint8_t *current = rows + changedCount * PACKED_ROW_SIZE;
+
+        packRow(session.machine.m_display, row, current);
+        if (std::memcmp(current, last, PACKED_ROW_SIZE) != 0)
+        {
+            std::memcpy(last, current, PACKED_ROW_SIZE);
+            changed |= 1u << row;
+            changedCount++;
+        }
+    }
+
+    uint32_t length = sizeof(changed) + changedCount * PACKED_ROW_SIZE;
+    MessageHeader header{protocol::FRAME_DELTA, 0, session.id, length};
+    auto const *headerBytes = reinterpret_cast<uint8_t const *>(&header);
+    auto const *changedBytes = reinterpret_cast<uint8_t const *>(&changed);
+
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+    out.insert(out.end(), changedBytes, changedBytes + sizeof(changed));
+    out.insert(out.end(), rows, rows + changedCount * PACKED_ROW_SIZE);
+}
+} // namespace chip8
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Chip8.h"
+#include "Frame.h"
+#include "Protocol.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+/* Headless server hosting many emulator sessions in one process.
+ * Clients connect to a Unix domain socket and talk the protocol in
+ * Protocol.h. A single epoll loop does all the socket I/O, while the
+ * requests of each session are handled, in order, on a fixed pool of
+ * worker threads, so the sessions of a connection run in parallel.
+ */
+class Server
+{
+public:
+    Server(std::string socketPath, int threads);
+    ~Server();
+    Server(Server const &) = delete;
+    Server &operator=(Server const &) = delete;
+
+    bool start(); // Binds the socket, returns false on failure
+    void run(); // Runs the event loop until stop() is called
+    void stop(); // Can be called from another thread or a signal handler
+
+private:
+    struct Connection;
+
+    struct Session
+    {
+        Connection *connection;
+        uint16_t id;
+        Chip8 machine;
+        uint32_t cyclesPerFrame = 1;
+        uint8_t lastFrame[PACKED_FRAME_SIZE]{}; // As last sent to the client
+
+        std::vector<uint8_t> queued; // Requests waiting for the session to be free
+        std::vector<uint8_t> requests; // Being handled by a worker
+        std::vector<uint8_t> replies; // Written by the worker
+        bool busy = false; // A worker owns machine, requests and replies
+        bool destroying = false; // DESTROY received, erased once the queued requests are done
+    };
+
+    struct Connection
+    {
+        int fd = -1;
+        std::vector<uint8_t> input; // Received, not parsed yet
+        std::vector<uint8_t> output; // Not sent yet
+        std::size_t queuedBytes = 0; // Requests parsed but not handled yet
+        std::map<uint16_t, std::unique_ptr<Session>> sessions;
+        uint16_t nextSession = 1;
+        int busySessions = 0;
+        bool readClosed = false; // The client won't send anything more
+        bool broken = false; // The socket failed, nothing more can be sent
+        uint32_t events = 0; // Registered with epoll, 0 if not registered
+    };
+
+    void accept();
+    void receive(Connection &connection);
+    void send(Connection &connection);
+    void parse(Connection &connection);
+    void schedule(Session &session);
+    void finishJobs();
+    void update(Connection &connection); // Registers the needed events, or closes the connection
+    void close(Connection &connection);
+
+    // Run on the worker threads
+    static void handleRequests(Session &session);
+    static void handleRequest(Session &session, protocol::MessageHeader const &header, uint8_t const *payload);
+    static void appendFrameDelta(Session &session, std::vector<uint8_t> &out);
+
+    std::string m_socketPath;
+    int m_threads;
+    int m_listenFd = -1;
+    int m_epollFd = -1;
+    int m_wakeUpFd = -1; // eventfd signalled by the workers and by stop()
+    std::atomic<bool> m_stopping{false};
+
+    std::map<int, std::unique_ptr<Connection>> m_connections;
+    std::mutex m_finishedMutex;
+    std::vector<Session *> m_finished; // Sessions whose job is done
+
+    std::unique_ptr<ThreadPool> m_pool; // Last, so the workers stop first
+};
+} // namespace chip8
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace chip8
+{
+// Fixed number of worker threads running jobs in submission order
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool(); // Finishes the queued jobs, then joins the workers
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    void submit(std::function<void()> job);
+
+private:
+    void work();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_stopping = false;
+};
+} // namespace chip8
@@ -0,0 +1,77 @@
+#include "TranspositionTable.h"
+
+namespace chip8
+{
+namespace
+{
+// 0 marks an empty slot, so it can't be stored as a key
+uint64_t toKey(uint64_t hash) { return hash ? hash : 1; }
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t capacity)
+{
+    // Round the capacity up to a power of two, so that the slot of a hash
+    // is just its low bits
+    std::size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    m_slots.reset(new std::atomic<uint64_t>[size]);
+    m_mask = size - 1;
+    clear();
+}
+
+bool TranspositionTable::insert(uint64_t hash)
+{
+    uint64_t key = toKey(hash);
+    std::size_t home = key & m_mask;
+
+    // Linear probing: claim the first empty slot, unless another thread has
+    // already stored the same key
+    for (int probe = 0; probe < MAX_PROBES; probe++)
+    {
+        std::atomic<uint64_t> &slot = m_slots[(home + probe) & m_mask];
+        uint64_t current = slot.load(std::memory_order_relaxed);
+
+        if (current == key)
+            return false;
+
+        if (current == 0)
+        {
+            if (slot.compare_exchange_strong(current, key, std::memory_order_relaxed))
+                return true;
+            if (current == key)
+                return false;
+        }
+    }
+
+    // No empty slot nearby: replace the home slot, forgetting an older state.
+    // Forgetting only costs some duplicate work, it never prunes a new state
+    m_slots[home].store(key, std::memory_order_relaxed);
+    return true;
+}
+
+bool TranspositionTable::contains(uint64_t hash) const
+{
+    uint64_t key = toKey(hash);
+    std::size_t home = key & m_mask;
+
+    for (int probe = 0; probe < MAX_PROBES; probe++)
+    {
+        uint64_t current = m_slots[(home + probe) & m_mask].load(std::memory_order_relaxed);
+
+        if (current == key)
+            return true;
+        if (current == 0)
+            return false;
+    }
+
+    return false;
+}
+
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i <= m_mask; i++)
+        m_slots[i].store(0, std::memory_order_relaxed);
+}
+} // namespace chip8
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace chip8
+{
+// Lock-free set of state hashes (see Chip8::stateHash()), shared between
+// threads to prune machine states that have already been explored
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(std::size_t capacity);
+
+    bool insert(uint64_t hash); // Returns false if the hash was already there
+    bool contains(uint64_t hash) const;
+    void clear();
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr int MAX_PROBES = 16; // Slots looked at before replacing one
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_slots;
+    std::size_t m_mask = 0; // Capacity - 1, the capacity is a power of two
+};
+} // namespace chip8
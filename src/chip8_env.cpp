@@ -0,0 +1,146 @@
+#include "chip8_env.h"
+#include "EnvBatch.h"
+
+using chip8::EnvBatch;
+using chip8::ObservationFormat;
+
+struct chip8_env
+{
+    explicit chip8_env(int count, int cyclesPerFrame, unsigned seed)
+        : batch(count, cyclesPerFrame, seed) {}
+
+    EnvBatch batch;
+};
+
+namespace
+{
+bool toFormat(int format, ObservationFormat &out)
+{
+    switch (format)
+    {
+        case CHIP8_OBS_PACKED_1BPP: out = ObservationFormat::Packed1bpp; return true;
+        case CHIP8_OBS_DOWNSAMPLED_8BIT: out = ObservationFormat::Downsampled8bit; return true;
+        default: return false;
+    }
+}
+} // namespace
+
+chip8_env *chip8_env_create(int count, int cycles_per_frame, uint32_t seed)
+{
+    if (count <= 0 || cycles_per_frame <= 0)
+        return nullptr;
+
+    // No C++ exception may cross the C boundary
+    try
+    {
+        return new chip8_env(count, cycles_per_frame, seed);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void chip8_env_destroy(chip8_env *env)
+{
+    delete env;
+}
+
+int chip8_env_count(const chip8_env *env)
+{
+    return env->batch.size();
+}
+
+int chip8_env_load_rom(chip8_env *env, const uint8_t *rom, size_t size)
+{
+    try
+    {
+        return env->batch.loadRom(rom, size) ? 0 : -1;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
+
+int chip8_env_reset(chip8_env *env, int index)
+{
+    if (index == -1)
+        env->batch.resetAll();
+    else if (index >= 0 && index < env->batch.size())
+        env->batch.reset(index);
+    else
+        return -1;
+
+    return 0;
+}
+
+int chip8_env_step(chip8_env *env, const uint16_t *actions, int frames)
+{
+    if (frames < 0)
+        return -1;
+
+    env->batch.step(actions, frames);
+    return 0;
+}
+
+size_t chip8_env_observation_size(int format)
+{
+    ObservationFormat observationFormat;
+    if (!toFormat(format, observationFormat))
+        return 0;
+
+    return chip8::observationSize(observationFormat);
+}
+
+int chip8_env_observe(const chip8_env *env, uint8_t *out, int format)
+{
+    ObservationFormat observationFormat;
+    if (!toFormat(format, observationFormat))
+        return -1;
+
+    env->batch.observe(out, observationFormat);
+    return 0;
+}
+
+int chip8_env_attach_buffer(chip8_env *env, void *buffer, size_t size, int format)
+{
+    ObservationFormat observationFormat;
+    if (!toFormat(format, observationFormat))
+        return -1;
+
+    return env->batch.attachBuffer(buffer, size, observationFormat) ? 0 : -1;
+}
+
+void *chip8_env_attach_shm(chip8_env *env, const char *name, int format)
+{
+    ObservationFormat observationFormat;
+    if (!toFormat(format, observationFormat))
+        return nullptr;
+
+    return env->batch.attachSharedMemory(name, observationFormat);
+}
+
+void chip8_env_detach(chip8_env *env)
+{
+    env->batch.detach();
+}
+
+void chip8_env_state_hashes(const chip8_env *env, uint64_t *out)
+{
+    env->batch.stateHashes(out);
+}
+
+int chip8_env_novel_states(chip8_env *env, uint8_t *out)
+{
+    // The first call allocates the table of seen states
+    try
+    {
+        env->batch.novelStates(out);
+        return 0;
+    }
+    catch (...)
+    {
+        return -1;
+    }
+}
@@ -0,0 +1,72 @@
+/* C API to drive batches of CHIP-8 emulators from other languages/processes.
+ * Observations are written straight into a caller-provided or POSIX shared
+ * memory buffer after every step, nothing is allocated while stepping.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define CHIP8_ENV_API __attribute__((visibility("default")))
+#else
+#define CHIP8_ENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct chip8_env chip8_env;
+
+enum chip8_observation_format
+{
+    CHIP8_OBS_PACKED_1BPP = 0, /* 64x32, 1 bit per pixel, 256 bytes per environment */
+    CHIP8_OBS_DOWNSAMPLED_8BIT = 1 /* 32x16, 1 byte per pixel, 512 bytes per environment */
+};
+
+/* Creates count environments, a frame being cycles_per_frame cycles.
+ * Environment i uses the random seed seed + i. Returns NULL on failure */
+CHIP8_ENV_API chip8_env *chip8_env_create(int count, int cycles_per_frame, uint32_t seed);
+CHIP8_ENV_API void chip8_env_destroy(chip8_env *env);
+CHIP8_ENV_API int chip8_env_count(const chip8_env *env);
+
+/* Loads the ROM into every environment and resets them. Returns 0 on success */
+CHIP8_ENV_API int chip8_env_load_rom(chip8_env *env, const uint8_t *rom, size_t size);
+
+/* Resets environment index to the state right after the ROM was loaded, or all of them if index is -1 */
+CHIP8_ENV_API int chip8_env_reset(chip8_env *env, int index);
+
+/* actions[i] is the keypad of environment i (bit k set = key k pressed),
+ * held for the given number of frames. Returns 0 on success, -1 if frames is negative */
+CHIP8_ENV_API int chip8_env_step(chip8_env *env, const uint16_t *actions, int frames);
+
+/* Bytes per environment for format, 0 if the format is unknown */
+CHIP8_ENV_API size_t chip8_env_observation_size(int format);
+
+/* Writes the observations of all environments into out, which must hold
+ * chip8_env_count() * chip8_env_observation_size() bytes. Returns 0 on success */
+CHIP8_ENV_API int chip8_env_observe(const chip8_env *env, uint8_t *out, int format);
+
+/* After this every step writes the observations into buffer, which must hold
+ * chip8_env_count() * chip8_env_observation_size() bytes. Returns 0 on success */
+CHIP8_ENV_API int chip8_env_attach_buffer(chip8_env *env, void *buffer, size_t size, int format);
+
+/* Same as above, but the buffer is the POSIX shared memory object name
+ * (created if needed). Returns the mapped buffer, or NULL on failure.
+ * The caller owns the name: the object is unmapped on detach/destroy but
+ * never unlinked, call shm_unlink() once every process is done with it */
+CHIP8_ENV_API void *chip8_env_attach_shm(chip8_env *env, const char *name, int format);
+CHIP8_ENV_API void chip8_env_detach(chip8_env *env);
+
+/* out[i] is the hash of the state of environment i */
+CHIP8_ENV_API void chip8_env_state_hashes(const chip8_env *env, uint64_t *out);
+
+/* out[i] is 1 if the state of environment i has not been seen by an
+ * earlier call, 0 if it is a duplicate that can be pruned. The first call
+ * allocates an 8 MB table. Returns 0 on success */
+CHIP8_ENV_API int chip8_env_novel_states(chip8_env *env, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,15 +2,18 @@
 #include "Platform.h"
 
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 
 int main(int argc, char **argv)
 {
     using namespace chip8;
+    using Clock = std::chrono::steady_clock;
+    constexpr auto PRESENT_INTERVAL = std::chrono::milliseconds(16); // Turbo presents at most at ~60 Hz
 
-    if (argc != 4)
+    if (argc < 4 || argc > 6)
     {
-        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM>\n";
+        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM> [Turbo] [FrameSkip]\n";
         std::exit(EXIT_FAILURE);
     }
 
@@ -18,28 +21,116 @@ int main(int argc, char **argv)
     int cycleDelay = std::stoi(argv[2]);
     char const *romFilename = argv[3];
 
+    // Turbo runs at turboSpeed times the normal speed (0 = as fast as possible)
+    // and presents at most once every frameSkip cycles, and never faster than
+    // the display refreshes. Tab toggles it at runtime
+    bool turbo = argc >= 5;
+    int turboSpeed = argc >= 5 ? std::stoi(argv[4]) : 0;
+    int frameSkip = argc == 6 ? std::stoi(argv[5]) : 16;
+    if (turboSpeed < 0 || frameSkip < 1)
+    {
+        std::cerr << "Turbo must be 0 (uncapped) or more, and FrameSkip 1 or more\n";
+        std::exit(EXIT_FAILURE);
+    }
+
     Platform platform("CHIP-8 Emulator", SCREEN_WIDTH * videoScale, SCREEN_HEIGHT * videoScale, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     Chip8 chip8;
+    chip8.setLogFaults(true);
     chip8.loadGame(romFilename);
 
     int videoPitch = sizeof(chip8.m_display[0]) * SCREEN_WIDTH;
 
+    // A cycle runs as soon as more than cycleDelay whole milliseconds have passed
+    double nominalPeriod = (cycleDelay + 1) / 1000.0; // Seconds per cycle
+    double turboDebt = 0; // Cycles owed to the turbo speed
+    long cycles = 0;
+
     auto lastCycleTime = std::chrono::high_resolution_clock::now();
+    auto lastTurboTime = Clock::now();
+    auto lastPresentTime = Clock::now();
+    long cyclesAtLastPresent = 0;
+    auto lastTitleTime = Clock::now();
+    long cyclesAtLastTitle = 0;
     bool quit = false;
 
     while (!quit)
     {
-        quit = Platform::ProcessInput(chip8.m_keypad);
+        bool wasTurbo = turbo;
+        quit = Platform::ProcessInput(chip8.m_keypad, turbo);
+
+        if (turbo)
+        {
+            auto now = Clock::now();
+            if (!wasTurbo)
+            {
+                lastTurboTime = now;
+                turboDebt = 0;
+            }
+
+            // Run at most a millisecond worth of cycles before polling the input again
+            long budget;
+            if (turboSpeed > 0)
+            {
+                turboDebt += std::chrono::duration<double>(now - lastTurboTime).count() * turboSpeed / nominalPeriod;
+                budget = static_cast<long>(turboDebt);
+                turboDebt -= budget;
+            }
+            else
+                budget = -1;
 
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastCycleTime).count();
+            auto deadline = now + std::chrono::milliseconds(1);
+            lastTurboTime = now;
 
-        if (elapsed > cycleDelay)
+            for (long i = 0; i != budget; i++)
+            {
+                chip8.cycle();
+                cycles++;
+
+                // Checking the clock on every cycle would cost more than the cycle
+                if (i % 64 == 63 && Clock::now() >= deadline)
+                {
+                    turboDebt = 0; // The host can't keep up, don't try to catch up
+                    break;
+                }
+            }
+
+            // Presenting is far slower than a cycle (and may wait for vsync),
+            // so it is limited to about 60 times per second
+            now = Clock::now();
+            if (cycles - cyclesAtLastPresent >= frameSkip && now - lastPresentTime >= PRESENT_INTERVAL)
+            {
+                platform.Update(chip8.m_display, videoPitch);
+                lastPresentTime = now;
+                cyclesAtLastPresent = cycles;
+            }
+        }
+        else
+        {
+            auto currentTime = std::chrono::high_resolution_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastCycleTime).count();
+
+            if (elapsed > cycleDelay)
+            {
+                lastCycleTime = currentTime;
+                chip8.cycle();
+                cycles++;
+                platform.Update(chip8.m_display, videoPitch);
+            }
+        }
+
+        // Show the measured speed in the window title once per second
+        auto now = Clock::now();
+        double sinceTitle = std::chrono::duration<double>(now - lastTitleTime).count();
+        if (sinceTitle >= 1.0)
         {
-            lastCycleTime = currentTime;
-            chip8.cycle();
-            platform.Update(chip8.m_display, videoPitch);
+            double hertz = (cycles - cyclesAtLastTitle) / sinceTitle;
+            char title[96];
+            std::snprintf(title, sizeof(title), "CHIP-8 Emulator%s - %.1fx (%.0f Hz)", turbo ? " [Turbo]" : "", hertz * nominalPeriod, hertz);
+            platform.SetTitle(title);
+
+            lastTitleTime = now;
+            cyclesAtLastTitle = cycles;
         }
     }
 
@@ -0,0 +1,46 @@
+#include "Server.h"
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace
+{
+chip8::Server *server = nullptr;
+
+void onSignal(int)
+{
+    if (server)
+        server->stop();
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    using namespace chip8;
+
+    if (argc != 2 && argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Socket> [Threads]\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    int threads = argc == 3 ? std::stoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 1)
+        threads = 1;
+
+    Server chip8Server(argv[1], threads);
+    if (!chip8Server.start())
+        std::exit(EXIT_FAILURE);
+
+    server = &chip8Server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    chip8Server.run();
+
+    server = nullptr;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "DiffHarness.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace chip8::fuzz;
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+bool sameCase(FuzzCase const &a, FuzzCase const &b)
+{
+    if (a.seed != b.seed || a.rom != b.rom || a.inputs.size() != b.inputs.size())
+        return false;
+
+    for (std::size_t i = 0; i < a.inputs.size(); i++)
+        if (a.inputs[i].cycle != b.inputs[i].cycle || a.inputs[i].keys != b.inputs[i].keys)
+            return false;
+
+    return true;
+}
+
+FuzzCase roundTrip(FuzzCase const &fuzzCase)
+{
+    std::vector<uint8_t> data = fuzzCase.encode();
+    return FuzzCase::decode(data.data(), data.size());
+}
+} // namespace
+
+int main()
+{
+    // Minimizing drops inputs, which leaves gaps of more than 255 cycles
+    FuzzCase minimized;
+    minimized.seed = 0xDEADBEEF;
+    minimized.inputs = {{0, 0x0001}, {400, 0x8000}, {400, 0x0000}, {CYCLES_PER_CASE - 1, 0xFFFF}};
+    minimized.rom = {0xF0, 0x0A, 0x12, 0x00};
+    check(sameCase(roundTrip(minimized), minimized), "minimized case survives encode/decode");
+
+    // Inputs past the end of the case have no effect and are not encoded
+    FuzzCase late = minimized;
+    late.inputs.push_back({CYCLES_PER_CASE + 70000, 0x1234});
+    check(sameCase(roundTrip(late), minimized), "late inputs are dropped");
+
+    // Anything decoded from bytes encodes back to the same case
+    std::mt19937 generator(1);
+    for (int i = 0; i < 1000; i++)
+    {
+        std::vector<uint8_t> data(generator() % 256);
+        for (uint8_t &value: data)
+            value = generator();
+
+        FuzzCase decoded = FuzzCase::decode(data.data(), data.size());
+        FuzzCase expected = decoded;
+        expected.inputs.clear();
+        for (InputEvent const &input: decoded.inputs)
+            if (input.cycle < CYCLES_PER_CASE)
+                expected.inputs.push_back(input);
+
+        check(sameCase(roundTrip(decoded), expected), "decoded case survives encode/decode");
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+#include "Server.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace chip8;
+using protocol::MessageHeader;
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+void sendMessage(int fd, uint8_t type, uint16_t session, void const *payload, uint32_t length)
+{
+    MessageHeader header{type, 0, session, length};
+    if (write(fd, &header, sizeof(header)) != sizeof(header) || (length && write(fd, payload, length) != static_cast<ssize_t>(length)))
+        check(false, "write request");
+}
+
+bool readAll(int fd, void *buffer, std::size_t size)
+{
+    auto *bytes = static_cast<uint8_t *>(buffer);
+    while (size > 0)
+    {
+        ssize_t received = read(fd, bytes, size);
+        if (received <= 0)
+            return false;
+        bytes += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool receiveMessage(int fd, MessageHeader &header, std::vector<uint8_t> &payload)
+{
+    if (!readAll(fd, &header, sizeof(header)))
+        return false;
+    payload.resize(header.length);
+    return readAll(fd, payload.data(), payload.size());
+}
+
+uint32_t deltaMask(std::vector<uint8_t> const &payload)
+{
+    uint32_t mask = 0;
+    std::memcpy(&mask, payload.data(), std::min(payload.size(), sizeof(mask)));
+    return mask;
+}
+} // namespace
+
+int main()
+{
+    std::string socketPath = "/tmp/chip8-server-test-" + std::to_string(getpid()) + ".sock";
+    Server server(socketPath, 2);
+    if (!server.start())
+        return EXIT_FAILURE;
+    std::thread loop(&Server::run, &server);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socketPath.c_str());
+    check(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0, "connect");
+
+    MessageHeader header{};
+    std::vector<uint8_t> payload;
+
+    // Session with 2 cycles per frame
+    uint32_t cyclesPerFrame = 2;
+    sendMessage(fd, protocol::CREATE, 0, &cyclesPerFrame, sizeof(cyclesPerFrame));
+    check(receiveMessage(fd, header, payload) && header.type == protocol::CREATED, "CREATE replies CREATED");
+    uint16_t session = header.session;
+
+    // Draws the font sprite of 0 at (5, 7), then loops forever
+    uint8_t rom[] = {0x60, 0x05, 0x61, 0x07, 0xA0, 0x50, 0xD0, 0x15, 0x12, 0x08};
+    sendMessage(fd, protocol::LOAD_ROM, session, rom, sizeof(rom));
+
+    // 3 frames are 6 cycles, the sprite is drawn by the 4th
+    uint32_t frames = 3;
+    sendMessage(fd, protocol::STEP, session, &frames, sizeof(frames));
+    check(receiveMessage(fd, header, payload) && header.type == protocol::FRAME_DELTA && header.session == session, "STEP replies FRAME_DELTA");
+    check(deltaMask(payload) == 0x1Fu << 7, "rows 7 to 11 changed");
+    check(payload.size() == 4 + 5 * PACKED_ROW_SIZE, "only the changed rows are sent");
+    check(payload.size() > 5 && payload[4] == 0x07 && payload[5] == 0x80, "first row of the sprite");
+
+    frames = 1;
+    sendMessage(fd, protocol::STEP, session, &frames, sizeof(frames));
+    check(receiveMessage(fd, header, payload) && header.type == protocol::FRAME_DELTA && deltaMask(payload) == 0 && payload.size() == 4, "idle STEP sends an empty delta");
+
+    frames = 0xFFFFFFFF;
+    sendMessage(fd, protocol::STEP, session, &frames, sizeof(frames));
+    check(receiveMessage(fd, header, payload) && header.type == protocol::ERROR && payload.size() == 1 && payload[0] == protocol::STEP, "oversized STEP is rejected");
+
+    uint16_t keys = 1;
+    sendMessage(fd, protocol::INPUT, session + 1, &keys, sizeof(keys));
+    check(receiveMessage(fd, header, payload) && header.type == protocol::ERROR && header.session == session + 1, "unknown session is rejected");
+
+    // Requests sent before a half-close are still replied to
+    frames = 1;
+    sendMessage(fd, protocol::STEP, session, &frames, sizeof(frames));
+    shutdown(fd, SHUT_WR);
+    check(receiveMessage(fd, header, payload) && header.type == protocol::FRAME_DELTA, "reply after half-close");
+    check(!receiveMessage(fd, header, payload), "connection closed after the last reply");
+
+    close(fd);
+    server.stop();
+    loop.join();
+
+    if (failures == 0)
+        std::cout << "Server round trip OK" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}